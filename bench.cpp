@@ -6,6 +6,7 @@
 
 #include <supercluster.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <iostream>
@@ -55,4 +56,9 @@ int main() {
             std::cerr << "point\n";
         }
     }
+
+    std::atomic<std::size_t> num_tiles{ 0 };
+    index.exportTiles(0, 14, [&](std::uint8_t, std::uint32_t, std::uint32_t,
+                                 const auto &) { num_tiles++; });
+    timer("export " + std::to_string(num_tiles) + " tiles z0-z14");
 }
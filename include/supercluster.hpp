@@ -5,12 +5,20 @@
 #include <mapbox/geometry/point_arithmetic.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <exception>
 #include <functional>
 #include <iomanip>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #ifdef DEBUG_TIMER
@@ -48,16 +56,25 @@ public:
     }
 
     mapbox::feature::feature<double> toGeoJSON() const {
+        return toGeoJSON(id);
+    }
+
+    // cluster_id overrides the stored id for clusters living on a shared zoom level
+    mapbox::feature::feature<double> toGeoJSON(const std::uint32_t cluster_id) const {
         const double x = (pos.x - 0.5) * 360.0;
         const double y =
             360.0 * std::atan(std::exp((180.0 - pos.y * 360.0) * M_PI / 180)) / M_PI - 90.0;
-        return { point<double>{ x, y }, getProperties(),
-                 identifier(static_cast<std::uint64_t>(id)) };
+        return { point<double>{ x, y }, getProperties(cluster_id),
+                 identifier(static_cast<std::uint64_t>(cluster_id)) };
     }
 
     property_map getProperties() const {
+        return getProperties(id);
+    }
+
+    property_map getProperties(const std::uint32_t cluster_id) const {
         property_map result{ { "cluster", true },
-                             { "cluster_id", static_cast<std::uint64_t>(id) },
+                             { "cluster_id", static_cast<std::uint64_t>(cluster_id) },
                              { "point_count", static_cast<std::uint64_t>(num_points) } };
         std::stringstream ss;
         if (num_points >= 1000) {
@@ -133,6 +150,8 @@ struct Options {
     std::function<void(property_map &, const property_map &)> reduce{ nullptr };
 };
 
+class CategorizedSupercluster;
+
 class Supercluster {
     using GeoJSONPoint = point<double>;
     using GeoJSONFeature = mapbox::feature::feature<double>;
@@ -157,14 +176,7 @@ public:
 #ifdef DEBUG_TIMER
         timer(std::to_string(features.size()) + " initial points");
 #endif
-        for (int z = options.maxZoom; z >= options.minZoom; z--) {
-            // cluster points from the previous zoom level
-            const double r = options.radius / (options.extent * std::pow(2, z));
-            zooms.emplace(z, Zoom(zooms[z + 1], r, z, options));
-#ifdef DEBUG_TIMER
-            timer(std::to_string(zooms[z].clusters.size()) + " clusters");
-#endif
-        }
+        clusterZooms();
     }
 
     TileFeatures
@@ -174,50 +186,151 @@ public:
         const auto zoom_iter = zooms.find(limitZoom(z));
         assert(zoom_iter != zooms.end());
         const auto &zoom = zoom_iter->second;
+        const auto &storage = zoom.storage();
 
         std::uint32_t z2 = std::pow(2, z);
         const double r = static_cast<double>(options.radius) / options.extent;
         std::int32_t x = x_;
 
         const auto visitor = [&, this](const auto &id) {
-            assert(id < zoom.clusters.size());
-            const auto &c = zoom.clusters[id];
-
-            const TilePoint point(::round(this->options.extent * (c.pos.x * z2 - x)),
-                                  ::round(this->options.extent * (c.pos.y * z2 - y)));
-
-            if (c.num_points == 1) {
-                const auto &original_feature = this->features[c.id];
-                // Generate feature id if options.generateId is set.
-                auto featureId = options.generateId ? identifier{static_cast<std::uint64_t>(c.id)} : original_feature.id;
-                result.emplace_back(point, original_feature.properties, std::move(featureId));
-            } else {
-                result.emplace_back(point, c.getProperties(),
-                                    identifier(static_cast<std::uint64_t>(c.id)));
-            }
+            assert(id < storage.clusters.size());
+            this->addTileFeature(result, zoom, id, z2, x, y);
         };
 
         const double top = (y - r) / z2;
         const double bottom = (y + 1 + r) / z2;
 
-        zoom.tree.range((x - r) / z2, top, (x + 1 + r) / z2, bottom, visitor);
+        storage.tree.range((x - r) / z2, top, (x + 1 + r) / z2, bottom, visitor);
 
         if (x_ == 0) {
             x = z2;
-            zoom.tree.range(1 - r / z2, top, 1, bottom, visitor);
+            storage.tree.range(1 - r / z2, top, 1, bottom, visitor);
         }
         if (x_ == z2 - 1) {
             x = -1;
-            zoom.tree.range(0, top, r / z2, bottom, visitor);
+            storage.tree.range(0, top, r / z2, bottom, visitor);
         }
 
         return result;
     }
 
+    // Calls sink(z, x, y, tile) for every non-empty tile from min_zoom to max_zoom, with the same
+    // features getTile(z, x, y) returns (possibly in a different order). All work runs on `threads`
+    // threads (all hardware threads by default), so the sink must be safe to call concurrently:
+    // first the clusters of every zoom level are bucketed into tiles in fixed-size chunks, then
+    // each level is split into ranges of tiles with about the same number of features, and each
+    // range is assembled and emitted as one task.
+    template <typename TSink>
+    void exportTiles(const std::uint8_t min_zoom,
+                     const std::uint8_t max_zoom,
+                     const TSink &sink,
+                     const std::size_t threads = 0) const {
+        const std::size_t chunk_size = 16384; // clusters bucketed per task
+        const std::size_t block_size = 8192;  // tile features assembled per task, roughly
+        const std::size_t sample_stride = 256;
+
+        struct Level {
+            std::uint8_t z;
+            std::uint32_t z2;
+            const Zoom *zoom;
+            std::vector<std::vector<TileEntry>> chunks; // each sorted by tile
+        };
+        std::vector<Level> levels;
+        std::vector<std::pair<std::size_t, std::size_t>> chunk_tasks; // (level, chunk)
+
+        for (std::uint32_t z = min_zoom; z <= max_zoom; z++) {
+            const auto zoom_iter = zooms.find(limitZoom(z));
+            assert(zoom_iter != zooms.end());
+            const auto num_clusters = zoom_iter->second.storage().clusters.size();
+            const auto num_chunks = (num_clusters + chunk_size - 1) / chunk_size;
+            for (std::size_t c = 0; c < num_chunks; c++) {
+                chunk_tasks.emplace_back(levels.size(), c);
+            }
+            levels.push_back({ static_cast<std::uint8_t>(z),
+                               static_cast<std::uint32_t>(std::pow(2, z)), &zoom_iter->second,
+                               std::vector<std::vector<TileEntry>>(num_chunks) });
+        }
+
+        parallelFor(chunk_tasks.size(), threads, [&, this](const std::size_t t) {
+            auto &level = levels[chunk_tasks[t].first];
+            auto &entries = level.chunks[chunk_tasks[t].second];
+            const auto &clusters = level.zoom->storage().clusters;
+            const auto begin = chunk_tasks[t].second * chunk_size;
+            const auto end = std::min(begin + chunk_size, clusters.size());
+            this->bucketClusters(clusters, begin, end, level.z2, entries);
+            std::sort(entries.begin(), entries.end());
+        });
+
+        // split each level at sampled tile keys into blocks [first, last) of about block_size
+        struct Block {
+            std::size_t level;
+            std::uint64_t first;
+            std::uint64_t last;
+        };
+        std::vector<Block> blocks;
+        for (std::size_t l = 0; l < levels.size(); l++) {
+            std::vector<std::uint64_t> samples;
+            for (const auto &chunk : levels[l].chunks) {
+                for (std::size_t i = 0; i < chunk.size(); i += sample_stride) {
+                    samples.push_back(chunk[i].key());
+                }
+            }
+            if (samples.empty()) {
+                continue;
+            }
+            std::sort(samples.begin(), samples.end());
+            std::uint64_t first = 0;
+            for (std::size_t i = block_size / sample_stride; i < samples.size();
+                 i += block_size / sample_stride) {
+                if (samples[i] > first) {
+                    blocks.push_back({ l, first, samples[i] });
+                    first = samples[i];
+                }
+            }
+            blocks.push_back({ l, first, std::numeric_limits<std::uint64_t>::max() });
+        }
+
+        parallelFor(blocks.size(), threads, [&, this](const std::size_t b) {
+            const auto &block = blocks[b];
+            const auto &level = levels[block.level];
+            const auto byKey = [](const TileEntry &entry, const std::uint64_t key) {
+                return entry.key() < key;
+            };
+
+            std::vector<TileEntry> entries;
+            for (const auto &chunk : level.chunks) {
+                const auto first =
+                    std::lower_bound(chunk.begin(), chunk.end(), block.first, byKey);
+                const auto last = std::lower_bound(first, chunk.end(), block.last, byKey);
+                entries.insert(entries.end(), first, last);
+            }
+            std::sort(entries.begin(), entries.end());
+
+            for (std::size_t begin = 0, end = 0; begin < entries.size(); begin = end) {
+                while (end < entries.size() && entries[end].key() == entries[begin].key()) {
+                    end++;
+                }
+                TileFeatures tile;
+                tile.reserve(end - begin);
+                for (std::size_t i = begin; i < end; i++) {
+                    const auto &entry = entries[i];
+                    const std::int32_t x = entry.wrap == TileEntry::Wrap::West
+                                               ? static_cast<std::int32_t>(level.z2)
+                                               : entry.wrap == TileEntry::Wrap::East
+                                                     ? -1
+                                                     : static_cast<std::int32_t>(entry.x);
+                    this->addTileFeature(tile, *level.zoom, entry.id, level.z2, x, entry.y);
+                }
+                sink(level.z, entries[begin].x, entries[begin].y, std::move(tile));
+            }
+        });
+    }
+
     GeoJSONFeatures getChildren(const std::uint32_t cluster_id) const {
         GeoJSONFeatures children;
-        eachChild(cluster_id,
-                  [&, this](const auto &c) { children.push_back(this->clusterToGeoJSON(c)); });
+        eachChild(cluster_id, [&, this](const auto &c, const auto &id) {
+            children.push_back(this->clusterToGeoJSON(c, id));
+        });
         return children;
     }
 
@@ -228,7 +341,9 @@ public:
         std::uint32_t skipped = 0;
         std::uint32_t limit_ = limit;
         eachLeaf(cluster_id, limit_, offset, skipped,
-                 [&, this](const auto &c) { leaves.push_back(this->clusterToGeoJSON(c)); });
+                 [&, this](const auto &c, const auto &id) {
+                     leaves.push_back(this->clusterToGeoJSON(c, id));
+                 });
         return leaves;
     }
 
@@ -237,9 +352,9 @@ public:
         while (cluster_zoom <= options.maxZoom) {
             std::uint32_t num_children = 0;
 
-            eachChild(cluster_id, [&](const auto &c) {
+            eachChild(cluster_id, [&](const auto &, const auto &id) {
                 num_children++;
-                cluster_id = c.id;
+                cluster_id = id;
             });
 
             cluster_zoom++;
@@ -251,13 +366,37 @@ public:
     }
 
 private:
+    friend class CategorizedSupercluster;
+
+    // Set for the categories of a CategorizedSupercluster, which share one feature store; features
+    // is left empty then.
+    const std::shared_ptr<const GeoJSONFeatures> shared_features;
+
+    // Clusters the features with the given ids, which were already projected by the caller.
+    Supercluster(std::shared_ptr<const GeoJSONFeatures> shared_features_,
+                 const std::vector<point<double>> &projected,
+                 const std::vector<std::uint32_t> &ids,
+                 Options options_)
+        : options(std::move(options_)), shared_features(std::move(shared_features_)) {
+        zooms.emplace(options.maxZoom + 1, Zoom(*shared_features, projected, ids, options));
+        clusterZooms();
+    }
+
     struct Zoom {
         kdbush::KDBush<Cluster, std::uint32_t> tree;
         std::vector<Cluster> clusters;
 
+        // Zoom levels on which nothing merges reuse the clusters and tree of the level they were
+        // built from (source) instead of copying them; ids are translated by clusterId/parentId.
+        Zoom *source = nullptr;
+        bool shared = false; // whether the next lower zoom level reuses this level's clusters
+        std::uint8_t zoom = 0;
+        std::size_t min_points = 0;
+
         Zoom() = default;
 
-        Zoom(const GeoJSONFeatures &features_, const Options &options_) {
+        Zoom(const GeoJSONFeatures &features_, const Options &options_)
+            : zoom(options_.maxZoom + 1), min_points(options_.minPoints) {
             // generate a cluster object for each point
             std::uint32_t i = 0;
             clusters.reserve(features_.size());
@@ -273,15 +412,52 @@ private:
             tree.fill(clusters);
         }
 
-        Zoom(Zoom &previous, const double r, const std::uint8_t zoom, const Options &options_) {
+        Zoom(const GeoJSONFeatures &features_,
+             const std::vector<point<double>> &projected,
+             const std::vector<std::uint32_t> &ids,
+             const Options &options_)
+            : zoom(options_.maxZoom + 1), min_points(options_.minPoints) {
+            // generate a cluster object for each of the given points, with feature indices as ids
+            clusters.reserve(ids.size());
+            for (const auto i : ids) {
+                if (options_.reduce) {
+                    clusters.emplace_back(projected[i], 1, i,
+                                          options_.map(features_[i].properties));
+                } else {
+                    clusters.emplace_back(projected[i], 1, i);
+                }
+            }
+            tree.fill(clusters);
+        }
+
+        Zoom(Zoom &previous_zoom, const double r, const std::uint8_t zoom_, const Options &options_)
+            : zoom(zoom_), min_points(options_.minPoints) {
 
             // The zoom parameter is restricted to [minZoom, maxZoom] by caller
             assert(((zoom + 1) & 0b11111) == (zoom + 1));
 
+            auto &previous = previous_zoom.storage();
+
             // Since point index is encoded in the upper 27 bits, clamp the count of clusters
             const auto previous_clusters_size = std::min(
                 previous.clusters.size(), static_cast<std::vector<Cluster>::size_type>(0x7ffffff));
 
+            // If no point has a neighbor within the radius, nothing merges on this level and every
+            // cluster keeps its index; share the previous level instead of rebuilding it.
+            bool isolated = previous_clusters_size == previous.clusters.size();
+            for (std::size_t i = 0; isolated && i < previous_clusters_size; i++) {
+                const auto &p = previous.clusters[i];
+                std::uint32_t num_neighbors = 0;
+                previous.tree.within(p.pos.x, p.pos.y, r,
+                                     [&](const auto &) { num_neighbors++; });
+                isolated = num_neighbors == 1;
+            }
+            if (isolated) {
+                source = &previous;
+                previous_zoom.shared = true;
+                return;
+            }
+
             for (std::size_t i = 0; i < previous_clusters_size; i++) {
                 auto &p = previous.clusters[i];
 
@@ -353,10 +529,98 @@ private:
 
             tree.fill(clusters);
         }
+
+        Zoom &storage() {
+            return source ? *source : *this;
+        }
+
+        const Zoom &storage() const {
+            return source ? *source : *this;
+        }
+
+        // id of the cluster at index i as seen on this zoom level
+        std::uint32_t clusterId(const std::uint32_t i) const {
+            const auto &c = storage().clusters[i];
+            if (!source || c.num_points < min_points) {
+                return c.id;
+            }
+            return static_cast<std::uint32_t>((i << 5) + (zoom + 1));
+        }
+
+        // id of the parent (on the next lower zoom level) of the cluster at index i
+        std::uint32_t parentId(const std::uint32_t i) const {
+            const auto &c = storage().clusters[i];
+            if (!shared) {
+                return c.parent_id;
+            }
+            return c.num_points < min_points ? 0 : static_cast<std::uint32_t>((i << 5) + zoom);
+        }
     };
 
     std::unordered_map<std::uint8_t, Zoom> zooms;
 
+    struct TileEntry {
+        // which antimeridian copy of the cluster the entry is, see getTile
+        enum class Wrap : std::uint8_t { None, West, East };
+
+        std::uint32_t x;
+        std::uint32_t y;
+        Wrap wrap;
+        std::uint32_t id;
+
+        // orders tiles row by row
+        std::uint64_t key() const {
+            return (static_cast<std::uint64_t>(y) << 32) | x;
+        }
+
+        bool operator<(const TileEntry &other) const {
+            return std::make_tuple(key(), wrap, id) <
+                   std::make_tuple(other.key(), other.wrap, other.id);
+        }
+    };
+
+    // Puts each of clusters[begin, end) in every tile whose buffered bounds contain it, including
+    // the copies getTile adds across the antimeridian for the first and last column.
+    void bucketClusters(const std::vector<Cluster> &clusters,
+                        const std::size_t begin,
+                        const std::size_t end,
+                        const std::uint32_t z2,
+                        std::vector<TileEntry> &entries) const {
+        const double r = static_cast<double>(options.radius) / options.extent;
+        for (auto i = static_cast<std::uint32_t>(begin); i < end; i++) {
+            const auto &pos = clusters[i].pos;
+            eachCoveringTile(pos.y, z2, r, [&](const std::uint32_t y) {
+                eachCoveringTile(pos.x, z2, r, [&](const std::uint32_t x) {
+                    entries.push_back({ x, y, TileEntry::Wrap::None, i });
+                });
+                if (pos.x >= 1 - r / z2 && pos.x <= 1) {
+                    entries.push_back({ 0, y, TileEntry::Wrap::West, i });
+                }
+                if (pos.x >= 0 && pos.x <= r / z2) {
+                    entries.push_back({ z2 - 1, y, TileEntry::Wrap::East, i });
+                }
+            });
+        }
+    }
+
+    void clusterZooms() {
+#ifdef DEBUG_TIMER
+        Timer timer;
+#endif
+        for (int z = options.maxZoom; z >= options.minZoom; z--) {
+            // cluster points from the previous zoom level
+            const double r = options.radius / (options.extent * std::pow(2, z));
+            zooms.emplace(z, Zoom(zooms[z + 1], r, z, options));
+#ifdef DEBUG_TIMER
+            timer(std::to_string(zooms[z].storage().clusters.size()) + " clusters");
+#endif
+        }
+    }
+
+    const GeoJSONFeatures &featureStore() const {
+        return shared_features ? *shared_features : features;
+    }
+
     std::uint8_t limitZoom(const std::uint8_t z) const {
         if (z < options.minZoom)
             return options.minZoom;
@@ -375,21 +639,21 @@ private:
             throw std::runtime_error("No cluster with the specified id.");
         }
 
-        auto &zoom = zoom_iter->second;
-        if (origin_id >= zoom.clusters.size()) {
+        const auto &zoom = zoom_iter->second;
+        const auto &storage = zoom.storage();
+        if (origin_id >= storage.clusters.size()) {
             throw std::runtime_error("No cluster with the specified id.");
         }
 
         const double r = options.radius / (double(options.extent) * std::pow(2, origin_zoom - 1));
-        const auto &origin = zoom.clusters[origin_id];
+        const auto &origin = storage.clusters[origin_id];
 
         bool hasChildren = false;
 
-        zoom.tree.within(origin.pos.x, origin.pos.y, r, [&](const auto &id) {
-            assert(id < zoom.clusters.size());
-            const auto &cluster_child = zoom.clusters[id];
-            if (cluster_child.parent_id == cluster_id) {
-                visitor(cluster_child);
+        storage.tree.within(origin.pos.x, origin.pos.y, r, [&](const auto &id) {
+            assert(id < storage.clusters.size());
+            if (zoom.parentId(id) == cluster_id) {
+                visitor(storage.clusters[id], zoom.clusterId(id));
                 hasChildren = true;
             }
         });
@@ -406,7 +670,7 @@ private:
                   std::uint32_t &skipped,
                   const TVisitor &visitor) const {
 
-        eachChild(cluster_id, [&, this](const auto &cluster_leaf) {
+        eachChild(cluster_id, [&, this](const auto &cluster_leaf, const auto &id) {
             if (limit == 0)
                 return;
             if (cluster_leaf.num_points > 1) {
@@ -415,7 +679,7 @@ private:
                     skipped += cluster_leaf.num_points;
                 } else {
                     // enter the cluster
-                    this->eachLeaf(cluster_leaf.id, limit, offset, skipped, visitor);
+                    this->eachLeaf(id, limit, offset, skipped, visitor);
                     // exit the cluster
                 }
             } else if (skipped < offset) {
@@ -423,14 +687,56 @@ private:
                 skipped++;
             } else {
                 // visit a single point
-                visitor(cluster_leaf);
+                visitor(cluster_leaf, id);
                 limit--;
             }
         });
     }
 
-    GeoJSONFeature clusterToGeoJSON(const Cluster &c) const {
-        return c.num_points == 1 ? features[c.id] : c.toGeoJSON();
+    void addTileFeature(TileFeatures &result,
+                        const Zoom &zoom,
+                        const std::uint32_t id,
+                        const std::uint32_t z2,
+                        const std::int32_t x,
+                        const std::uint32_t y) const {
+        const auto &c = zoom.storage().clusters[id];
+        const auto cluster_id = zoom.clusterId(id);
+
+        const TilePoint point(::round(options.extent * (c.pos.x * z2 - x)),
+                              ::round(options.extent * (c.pos.y * z2 - y)));
+
+        if (c.num_points == 1) {
+            const auto &original_feature = featureStore()[cluster_id];
+            // Generate feature id if options.generateId is set.
+            auto featureId = options.generateId
+                                 ? identifier{ static_cast<std::uint64_t>(cluster_id) }
+                                 : original_feature.id;
+            result.emplace_back(point, original_feature.properties, std::move(featureId));
+        } else {
+            result.emplace_back(point, c.getProperties(cluster_id),
+                                identifier(static_cast<std::uint64_t>(cluster_id)));
+        }
+    }
+
+    // visits the tiles t in [0, z2) whose range query in getTile, widened by r, contains p
+    template <typename TVisitor>
+    static void eachCoveringTile(const double p,
+                                 const std::uint32_t z2,
+                                 const double r,
+                                 const TVisitor &visitor) {
+        const double t = p * z2;
+        const auto first = static_cast<std::int64_t>(std::max(std::floor(t - 1 - r) - 1, 0.0));
+        const auto last = static_cast<std::int64_t>(std::min(std::floor(t + r) + 1, z2 - 1.0));
+        for (auto i = first; i <= last; i++) {
+            // same bounds as getTile so that rounding cannot disagree at tile edges
+            if ((i - r) / z2 <= p && p <= (i + 1 + r) / z2) {
+                visitor(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    GeoJSONFeature clusterToGeoJSON(const Cluster &c, const std::uint32_t id) const {
+        return c.num_points == 1 ? featureStore()[id] : c.toGeoJSON(id);
     }
 
     static point<double> project(const GeoJSONPoint &p) {
@@ -440,6 +746,145 @@ private:
         const auto latY = std::min(std::max(y, 0.0), 1.0);
         return { lngX, latY };
     }
+
+    // Runs task(i) for every i in [0, n) on up to `threads` threads including the calling one (all
+    // hardware threads if 0). The first exception thrown by a task is rethrown after all finished.
+    template <typename TTask>
+    static void parallelFor(const std::size_t n, std::size_t threads, const TTask &task) {
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::atomic<std::size_t> next{ 0 };
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        const auto worker = [&] {
+            try {
+                for (std::size_t i = next++; i < n; i = next++) {
+                    task(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = n;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (std::size_t i = 1; i < std::min(threads, n); i++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : pool) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Clusters the same features separately for each category (e.g. one hierarchy per kind of place).
+// The features are stored and projected once, and the categories are clustered in parallel.
+class CategorizedSupercluster {
+    using GeoJSONFeature = mapbox::feature::feature<double>;
+    using GeoJSONFeatures = feature_collection<double>;
+    using TileFeatures = feature_collection<std::int16_t>;
+
+public:
+    const std::shared_ptr<const GeoJSONFeatures> features;
+    const Options options;
+
+    // category(feature) names the category of each feature. Categories are built on `threads`
+    // threads (all hardware threads by default), so options.map and options.reduce must be safe to
+    // call concurrently.
+    CategorizedSupercluster(const GeoJSONFeatures &features_,
+                            const std::function<std::string(const GeoJSONFeature &)> &category,
+                            Options options_ = Options(),
+                            const std::size_t threads = 0)
+        : features(std::make_shared<const GeoJSONFeatures>(features_)),
+          options(std::move(options_)) {
+
+        std::vector<point<double>> projected;
+        projected.reserve(features->size());
+        std::unordered_map<std::string, std::vector<std::uint32_t>> category_ids;
+        for (std::uint32_t i = 0; i < features->size(); i++) {
+            const auto &f = (*features)[i];
+            projected.push_back(Supercluster::project(f.geometry.get<point<double>>()));
+            category_ids[category(f)].push_back(i);
+        }
+
+        std::vector<const std::pair<const std::string, std::vector<std::uint32_t>> *> tasks;
+        for (const auto &entry : category_ids) {
+            tasks.push_back(&entry);
+        }
+        std::vector<std::unique_ptr<Supercluster>> built(tasks.size());
+        Supercluster::parallelFor(tasks.size(), threads, [&, this](const std::size_t i) {
+            built[i].reset(new Supercluster(features, projected, tasks[i]->second, options));
+        });
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            indexes.emplace(tasks[i]->first, std::move(built[i]));
+        }
+    }
+
+    std::vector<std::string> getCategories() const {
+        std::vector<std::string> result;
+        for (const auto &index : indexes) {
+            result.push_back(index.first);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    TileFeatures getTile(const std::string &category,
+                         const std::uint8_t z,
+                         const std::uint32_t x,
+                         const std::uint32_t y) const {
+        return getIndex(category).getTile(z, x, y);
+    }
+
+    // Returns the tile of each requested category (e.g. one vector tile layer each), in order.
+    std::vector<TileFeatures> getTileLayers(const std::vector<std::string> &categories,
+                                            const std::uint8_t z,
+                                            const std::uint32_t x,
+                                            const std::uint32_t y) const {
+        std::vector<TileFeatures> result;
+        result.reserve(categories.size());
+        for (const auto &category : categories) {
+            result.push_back(getIndex(category).getTile(z, x, y));
+        }
+        return result;
+    }
+
+    GeoJSONFeatures getChildren(const std::string &category, const std::uint32_t cluster_id) const {
+        return getIndex(category).getChildren(cluster_id);
+    }
+
+    GeoJSONFeatures getLeaves(const std::string &category,
+                              const std::uint32_t cluster_id,
+                              const std::uint32_t limit = 10,
+                              const std::uint32_t offset = 0) const {
+        return getIndex(category).getLeaves(cluster_id, limit, offset);
+    }
+
+    std::uint8_t getClusterExpansionZoom(const std::string &category,
+                                         const std::uint32_t cluster_id) const {
+        return getIndex(category).getClusterExpansionZoom(cluster_id);
+    }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<Supercluster>> indexes;
+
+    const Supercluster &getIndex(const std::string &category) const {
+        const auto iter = indexes.find(category);
+        if (iter == indexes.end()) {
+            throw std::runtime_error("No category with the specified name.");
+        }
+        return *iter->second;
+    }
 };
 
 } // namespace supercluster
@@ -4,9 +4,13 @@
 
 #include <supercluster.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 
 mapbox::feature::feature_collection<double> parseFeatures(const char *filename) {
@@ -210,4 +214,161 @@ int main() {
     }
 
     assert((ids == std::vector<uint64_t>{12, 20, 21, 22, 24, 28, 30, 62, 81, 118, 119, 125, 81, 118}));
+
+    // ----------------------- test for shared zoom levels ---------------
+    mapbox::feature::feature_collection<double> sparseFeatures{
+        { mapbox::geometry::point<double>(0, 0) },
+        { mapbox::geometry::point<double>(0.0001, 0) },
+        { mapbox::geometry::point<double>(100, 50) },
+    };
+    mapbox::supercluster::Supercluster sparseIndex(sparseFeatures);
+
+    auto sparseTile = sparseIndex.getTile(0, 0, 0);
+    assert(sparseTile.size() == 2);
+    assert(sparseTile[0].id.get<std::uint64_t>() == 1);
+    assert(sparseTile[0].properties["cluster_id"].get<std::uint64_t>() == 1);
+    assert(sparseIndex.getTile(10, 512, 512)[0].id.get<std::uint64_t>() == 11);
+    assert(sparseIndex.getChildren(1).size() == 1);
+    assert(sparseIndex.getChildren(1)[0].id.get<std::uint64_t>() == 2);
+    assert(sparseIndex.getChildren(17).size() == 2);
+    assert(sparseIndex.getLeaves(1).size() == 2);
+    assert(sparseIndex.getClusterExpansionZoom(1) == 17);
+
+    // ----------------------- test for exportTiles ----------------------
+    using TileKey = std::tuple<std::uint8_t, std::uint32_t, std::uint32_t>;
+    const auto sortedIds = [](const mapbox::feature::feature_collection<std::int16_t> &features_) {
+        std::vector<std::tuple<std::uint64_t, std::int16_t, std::int16_t>> result;
+        for (const auto &feature : features_) {
+            const auto &point = feature.geometry.get<mapbox::geometry::point<std::int16_t>>();
+            result.emplace_back(feature.id.get<std::uint64_t>(), point.x, point.y);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    const auto checkExport = [&](const mapbox::supercluster::Supercluster &exportIndex,
+                                 const std::uint8_t maxZoom, const std::size_t threads) {
+        std::mutex exportMutex;
+        std::size_t numExported = 0;
+        std::map<TileKey, mapbox::feature::feature_collection<std::int16_t>> exported;
+        exportIndex.exportTiles(
+            0, maxZoom,
+            [&](std::uint8_t z, std::uint32_t x, std::uint32_t y,
+                mapbox::feature::feature_collection<std::int16_t> &&tile_) {
+                std::lock_guard<std::mutex> lock(exportMutex);
+                exported.emplace(TileKey(z, x, y), std::move(tile_));
+                numExported++;
+            },
+            threads);
+
+        std::size_t nonEmptyTiles = 0;
+        for (std::uint8_t z = 0; z <= maxZoom; z++) {
+            for (std::uint32_t x = 0; x < (1u << z); x++) {
+                for (std::uint32_t y = 0; y < (1u << z); y++) {
+                    const auto expected = exportIndex.getTile(z, x, y);
+                    const auto iter = exported.find(TileKey(z, x, y));
+                    if (expected.empty()) {
+                        assert(iter == exported.end());
+                    } else {
+                        assert(iter != exported.end());
+                        assert(sortedIds(iter->second) == sortedIds(expected));
+                        nonEmptyTiles++;
+                    }
+                }
+            }
+        }
+        assert(numExported == nonEmptyTiles);
+        return exported;
+    };
+
+    checkExport(generateIdIndex, 5, 4);
+
+    // a grid reaching both sides of the antimeridian, large enough to be bucketed in several
+    // chunks and assembled in several blocks per zoom level
+    mapbox::feature::feature_collection<double> gridFeatures;
+    for (int i = 0; i <= 150; i++) {
+        for (int j = 0; j < 140; j++) {
+            gridFeatures.push_back(
+                { mapbox::geometry::point<double>(-180 + i * 2.4, -80 + j * 1.15) });
+        }
+    }
+    mapbox::supercluster::Options gridOptions;
+    gridOptions.maxZoom = 2;
+    gridOptions.generateId = true;
+    mapbox::supercluster::Supercluster gridIndex(gridFeatures, gridOptions);
+
+    const auto gridTiles = checkExport(gridIndex, 6, 3);
+
+    // at z0 the clusters near the antimeridian are also added beyond the opposite tile edge
+    bool wrappedWest = false;
+    bool wrappedEast = false;
+    for (const auto &feature : gridTiles.at(TileKey(0, 0, 0))) {
+        const auto &point = feature.geometry.get<mapbox::geometry::point<std::int16_t>>();
+        wrappedWest = wrappedWest || point.x < 0;
+        wrappedEast = wrappedEast || point.x > gridOptions.extent;
+    }
+    assert(wrappedWest && wrappedEast);
+
+    // ----------------------- test for CategorizedSupercluster ----------
+    const auto featureClass = [](const mapbox::feature::feature<double> &feature) {
+        return feature.properties.at("featureclass").get<std::string>();
+    };
+    mapbox::supercluster::CategorizedSupercluster categorizedIndex(features, featureClass,
+                                                                   options3);
+
+    assert((categorizedIndex.getCategories() ==
+            std::vector<std::string>{ "cape", "island", "plain", "pole", "waterfall" }));
+
+    const auto describe = [](const mapbox::feature::feature_collection<std::int16_t> &tile_) {
+        std::vector<std::tuple<std::string, std::int16_t, std::int16_t>> result;
+        for (auto feature : tile_) {
+            const auto &point = feature.geometry.get<mapbox::geometry::point<std::int16_t>>();
+            const auto itr = feature.properties.find("cluster");
+            if (itr != feature.properties.end()) {
+                const auto sum = feature.properties["sum"].get<std::uint64_t>();
+                result.emplace_back(std::to_string(feature.id.get<std::uint64_t>()) + "/" +
+                                        std::to_string(sum),
+                                    point.x, point.y);
+            } else {
+                result.emplace_back(feature.properties["name"].get<std::string>(), point.x,
+                                    point.y);
+            }
+        }
+        return result;
+    };
+
+    for (const std::string category : { "cape", "island" }) {
+        mapbox::feature::feature_collection<double> categoryFeatures;
+        for (const auto &feature : features) {
+            if (featureClass(feature) == category) {
+                categoryFeatures.push_back(feature);
+            }
+        }
+        mapbox::supercluster::Supercluster categoryIndex(categoryFeatures, options3);
+
+        for (std::uint32_t y = 0; y < 2; y++) {
+            for (std::uint32_t x = 0; x < 2; x++) {
+                assert(describe(categorizedIndex.getTile(category, 1, x, y)) ==
+                       describe(categoryIndex.getTile(1, x, y)));
+            }
+        }
+        for (const auto &feature : categoryIndex.getTile(0, 0, 0)) {
+            if (feature.properties.find("cluster") == feature.properties.end()) {
+                continue;
+            }
+            const auto cluster_id = feature.id.get<std::uint64_t>();
+            assert(categorizedIndex.getClusterExpansionZoom(category, cluster_id) ==
+                   categoryIndex.getClusterExpansionZoom(cluster_id));
+            assert(categorizedIndex.getChildren(category, cluster_id).size() ==
+                   categoryIndex.getChildren(cluster_id).size());
+            assert(categorizedIndex.getLeaves(category, cluster_id, 5, 1)[0].properties["name"] ==
+                   categoryIndex.getLeaves(cluster_id, 5, 1)[0].properties["name"]);
+        }
+    }
+
+    const auto layers = categorizedIndex.getTileLayers({ "pole", "waterfall" }, 0, 0, 0);
+    assert(layers.size() == 2);
+    assert(describe(layers[0]) == describe(categorizedIndex.getTile("pole", 0, 0, 0)));
+    assert(describe(layers[1]) == describe(categorizedIndex.getTile("waterfall", 0, 0, 0)));
+    assert(layers[1].size() == 4);
 }